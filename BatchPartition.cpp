@@ -0,0 +1,164 @@
+#include <iostream>
+#include <fstream>
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <stdexcept>
+#include <sched.h>
+#include <unistd.h>
+#include "BatchPartition.hpp"
+
+
+namespace
+{
+	// Parses a cpulist of the sysfs ("0-3,8-11")
+	std::vector<int> parse_cpulist(const std::string & list)
+	{
+		std::vector<int>	cpus;
+		std::istringstream	ranges(list);
+		
+		for(std::string range; std::getline(ranges, range, ',');)
+		{
+			const std::size_t dash = range.find('-');
+			
+			try
+			{
+				const int first = std::stoi(range.substr(0, dash));
+				const int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+				
+				for(int cpu = first; cpu <= last; ++cpu)
+					cpus.push_back(cpu);
+			}
+			catch(const std::exception &)
+			{
+				continue;
+			}
+		}
+		
+		return cpus;
+	}
+}
+
+
+/*!
+ * Partition solved by n_threads threads (0 = the default number of OpenMP threads)
+ *
+ */
+
+BatchPartition::BatchPartition(const std::size_t & n_, const std::size_t & block_size_, const unsigned int & n_threads_)
+: n(n_), block_size(std::max<std::size_t>(block_size_, 1u)), n_threads(n_threads_)
+{
+#ifdef _OPENMP
+	if(n_threads == 0u)
+		n_threads = omp_get_max_threads();
+#else
+	n_threads = 1u;
+#endif
+}
+
+
+/*!
+ * It returns the CPUs in the affinity mask of the process
+ *
+ */
+
+std::vector<int>
+BatchPartition::available_cpus()
+{
+	std::vector<int>	cpus;
+	cpu_set_t			set;
+	
+	CPU_ZERO(&set);
+	if(sched_getaffinity(0, sizeof(set), &set) != 0)
+		return cpus;
+	
+	for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		if(CPU_ISSET(cpu, &set))
+			cpus.push_back(cpu);
+	
+	return cpus;
+}
+
+
+/*!
+ * It returns the number of NUMA nodes of the machine (1 if the sysfs does not describe them)
+ *
+ */
+
+unsigned int
+BatchPartition::n_nodes()
+{
+	unsigned int nodes{0u};
+	
+	while(std::ifstream("/sys/devices/system/node/node" + std::to_string(nodes) + "/cpulist"))
+		++nodes;
+	
+	return std::max(nodes, 1u);
+}
+
+
+/*!
+ * It returns the available CPUs of the first n_nodes NUMA nodes, node by node
+ * Without NUMA information all the available CPUs are considered as one node
+ *
+ */
+
+std::vector<int>
+BatchPartition::node_cpus(const unsigned int & n_nodes_)
+{
+	const std::vector<int>	available = available_cpus();
+	std::vector<int>		cpus;
+	
+	for(unsigned int node = 0u; node < n_nodes_; ++node)
+	{
+		std::ifstream	file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+		std::string		list;
+		
+		if(!std::getline(file, list))
+			return available;
+		
+		for(int cpu : parse_cpulist(list))
+			if(std::find(available.begin(), available.end(), cpu) != available.end())
+				cpus.push_back(cpu);
+	}
+	
+	return cpus.empty() ? available : cpus;
+}
+
+
+/*!
+ * Number of lanes of a block that fits in half of the L2 cache
+ *
+ * bytes_per_lane --> memory used by a lane (inputs, iterates and outputs)
+ *
+ */
+
+std::size_t
+BatchPartition::cache_block_size(const std::size_t & bytes_per_lane)
+{
+	long cache = sysconf(_SC_LEVEL2_CACHE_SIZE);
+	
+	if(cache <= 0)
+		cache = 256 * 1024;
+	
+	return std::max<std::size_t>(cache / 2 / std::max<std::size_t>(bytes_per_lane, 1u), 1u);
+}
+
+
+/*!
+ * Checks that the calling thread of the team is bound to an OpenMP place: if it is not, the 
+ * first touch locality is not guaranteed and a warning is printed (once)
+ *
+ */
+
+void
+BatchPartition::checkBinding()
+{
+#ifdef _OPENMP
+	static std::atomic<bool> warned{false};
+	
+	if(omp_get_num_threads() > 1 && omp_get_place_num() < 0 && !warned.exchange(true))
+		std::cout << "WARNING: the threads of the batched solve are not bound to CPUs, "
+				  << "set OMP_PLACES (e.g. OMP_PLACES=cores)" << std::endl;
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef HH__BATCH_PARTITION__HH
+#define HH__BATCH_PARTITION__HH
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+// Static partition of a batch of n lanes in cache-sized blocks, solved by a team of OpenMP threads.
+// The team is bound to the OpenMP places (OMP_PLACES) with proc_bind(close) and each thread always 
+// gets the same contiguous range of blocks, so the pages it touches first (e.g. while initializing
+// the inputs) are allocated on its NUMA node and reused by the solve
+class BatchPartition
+{
+	public: BatchPartition(const std::size_t & n_, const std::size_t & block_size_, const unsigned int & n_threads_);
+			
+			template<class Fun>
+			void run(const Fun & fun) const;
+			
+			inline std::size_t get_block_size() const { return block_size; };
+			inline unsigned int get_n_threads() const { return n_threads; };
+			
+			static std::vector<int> available_cpus();
+			
+			static std::vector<int> node_cpus(const unsigned int & n_nodes_);
+			
+			static unsigned int n_nodes();
+			
+			static std::size_t cache_block_size(const std::size_t & bytes_per_lane);
+			
+	private: const std::size_t n;
+			 const std::size_t block_size;
+			 unsigned int n_threads;
+			 
+			 static void checkBinding();
+};
+
+
+/*!
+ * Calls fun(begin, end) on every block of the batch, the blocks of a thread one after the other
+ *
+ */
+
+template<class Fun>
+void
+BatchPartition::run(const Fun & fun) const
+{
+	const std::size_t	n_blocks = (n + block_size - 1) / block_size;
+	const int			team = static_cast<int>(std::max<std::size_t>(std::min<std::size_t>(n_threads, n_blocks), 1u));
+	
+	#pragma omp parallel num_threads(team) proc_bind(close)
+	{
+#ifdef _OPENMP
+		const std::size_t	t = omp_get_thread_num();
+		const std::size_t	n_team = omp_get_num_threads();
+#else
+		const std::size_t	t = 0u;
+		const std::size_t	n_team = 1u;
+#endif
+		
+		checkBinding();
+		
+		for(std::size_t b = t * n_blocks / n_team; b < (t + 1) * n_blocks / n_team; ++b)
+			fun(b * block_size, std::min(n, (b + 1) * block_size));
+	}
+}
+
+#endif
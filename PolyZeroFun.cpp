@@ -0,0 +1,261 @@
+#include <cmath>
+#include <algorithm>
+#include "PolyZeroFun.hpp"
+#include "Profiler.hpp"
+
+
+/*!
+ * Removes the leading zero coefficients of a polynomial
+ *
+ */
+
+PolySolverTraits::Coefficients
+PolySolverBase::normalize(const Coefficients & c)
+{
+	auto first = std::find_if(c.begin(), c.end(), [](const Complex & ci){ return ci != 0.; });
+	return Coefficients(first, c.end());
+}
+
+
+/*!
+ * Initial approximations of the roots: points on a circle whose radius bounds the moduli
+ * of the roots, rotated to avoid symmetric configurations. The radius is the Fujiwara bound
+ * 2 max(|c_i/c_0|^(1/i) for i < n, |c_n/(2 c_0)|^(1/n))
+ *
+ * c --> coefficients (c[0] != 0)
+ * zr, zi --> real and imaginary parts of the initial approximations
+ *
+ */
+
+void
+PolySolverBase::initialGuess(const Coefficients & c, std::vector<Real> & zr, std::vector<Real> & zi)
+{
+	const Uint		n = c.size() - 1;
+	Real			radius{0.};
+	
+	for(Uint i = 1u; i < n; ++i)
+		radius = std::max(radius, std::pow(std::abs(c[i] / c[0]), 1. / i));
+	
+	radius = 2. * std::max(radius, std::pow(std::abs(c[n] / (2. * c[0])), 1. / n));
+	radius = (radius > 0.) ? radius : 1.;
+	
+	zr.resize(n);
+	zi.resize(n);
+	
+	for(Uint k = 0u; k < n; ++k)
+	{
+		Real theta = 2. * M_PI * k / n + 0.4;
+		zr[k] = radius * std::cos(theta);
+		zi[k] = radius * std::sin(theta);
+	}
+}
+
+
+/*!
+ * Evaluates the polynomial and its derivative at all the approximations with the Horner scheme
+ * The approximations are stored as separate real and imaginary arrays, so that the loop over
+ * the roots can be vectorised
+ *
+ * c --> coefficients
+ * zr, zi --> real and imaginary parts of the points
+ * pr, pi --> real and imaginary parts of p(z)
+ * dpr, dpi --> real and imaginary parts of p'(z)
+ *
+ */
+
+void
+PolySolverBase::horner(const Coefficients & c, const std::vector<Real> & zr, const std::vector<Real> & zi,
+					   std::vector<Real> & pr, std::vector<Real> & pi, std::vector<Real> & dpr, std::vector<Real> & dpi)
+{
+	const std::size_t	n = zr.size();
+	
+	std::fill(pr.begin(), pr.end(), c[0].real());
+	std::fill(pi.begin(), pi.end(), c[0].imag());
+	std::fill(dpr.begin(), dpr.end(), 0.);
+	std::fill(dpi.begin(), dpi.end(), 0.);
+	
+	for(std::size_t i = 1u; i < c.size(); ++i)
+	{
+		const Real cr = c[i].real();
+		const Real ci = c[i].imag();
+		
+		#pragma omp simd
+		for(std::size_t k = 0u; k < n; ++k)
+		{
+			// dp = dp * z + p,  p = p * z + c
+			Real tr = dpr[k] * zr[k] - dpi[k] * zi[k] + pr[k];
+			Real ti = dpr[k] * zi[k] + dpi[k] * zr[k] + pi[k];
+			dpr[k] = tr;
+			dpi[k] = ti;
+			
+			tr = pr[k] * zr[k] - pi[k] * zi[k] + cr;
+			ti = pr[k] * zi[k] + pi[k] * zr[k] + ci;
+			pr[k] = tr;
+			pi[k] = ti;
+		}
+	}
+}
+
+
+/*!
+ * Computes the roots of many polynomials, in parallel over the polynomials
+ *
+ * batch --> the coefficients of the polynomials
+ * It returns the roots and the status of each polynomial
+ *
+ */
+
+std::vector<PolySolverTraits::PolySolverOutput>
+PolySolverBase::solve_batch(const std::vector<Coefficients> & batch) const
+{
+	std::vector<PolySolverOutput> res(batch.size());
+	
+	#pragma omp parallel for schedule(dynamic)
+	for(std::size_t i = 0u; i < batch.size(); ++i)
+		res[i] = compute(batch[i]);
+	
+	return res;
+}
+
+
+/*!
+ * Computes all the roots of a polynomial by simultaneous iterations
+ * All the corrections (given by the method through correction()) are computed from the
+ * approximations of the previous iteration (Jacobi style), so that the roots are updated in
+ * parallel. A root stops moving when |correction| <= tol |root| + tola
+ *
+ * c --> coefficients (highest degree first)
+ * tol --> relative tolerance
+ * tola --> absolute tolerance
+ * maxIt --> maximum number of iterations
+ * It returns the approximations of the roots and a status (true if all the roots converged)
+ *
+ * Near a root of multiplicity m the corrections become small before the error does: in double
+ * precision such a root can only be approximated to about 1e-16^(1/m) (e.g. ~5e-6 for a triple
+ * root), whatever the tolerance
+ *
+ */
+
+PolySolverTraits::PolySolverOutput
+PolySolverBase::compute(const Coefficients & coeff_) const
+{
+	ZEROFUN_PROFILE_SCOPE(name());
+
+	const Coefficients	c = normalize(coeff_);
+	
+	if(c.empty())
+		return std::make_pair(Roots{}, false);
+	
+	const Uint			n = c.size() - 1;
+	std::vector<Real>	zr, zi;
+	std::vector<Real>	pr(n), pi(n), dpr(n), dpi(n);
+	std::vector<Complex> w(n);
+	std::vector<char>	converged(n, 0);
+	Uint				n_converged{0u};
+	unsigned int		iter{0u};
+	
+	initialGuess(c, zr, zi);
+	
+	while(n_converged < n && iter < maxIt)
+	{
+		++iter;
+		horner(c, zr, zi, pr, pi, dpr, dpi);
+		
+		#pragma omp parallel for if(n > 64)
+		for(Uint k = 0u; k < n; ++k)
+			w[k] = converged[k] ? Complex{0.} : 
+				   correction(c, k, zr, zi, Complex{pr[k], pi[k]}, Complex{dpr[k], dpi[k]});
+		
+		for(Uint k = 0u; k < n; ++k)
+		{
+			if(converged[k])
+				continue;
+			
+			zr[k] -= w[k].real();
+			zi[k] -= w[k].imag();
+			
+			// A NaN correction can not be improved: the root is frozen and the status will be false
+			if(std::abs(w[k]) <= tol * std::abs(Complex{zr[k], zi[k]}) + tola || std::isnan(std::abs(w[k])))
+			{
+				converged[k] = 1;
+				++n_converged;
+			}
+		}
+	}
+	
+	Roots	roots(n);
+	bool	finite{true};
+	
+	for(Uint k = 0u; k < n; ++k)
+	{
+		roots[k] = Complex{zr[k], zi[k]};
+		finite = finite && std::isfinite(zr[k]) && std::isfinite(zi[k]);
+	}
+	
+	return std::make_pair(roots, n_converged == n && finite);
+}
+
+
+/*!
+ * Aberth-Ehrlich correction of the k-th root: w = (p/p') / (1 - (p/p') sum_{j!=k} 1/(z_k - z_j))
+ *
+ */
+
+PolySolverTraits::Complex
+AberthEhrlich::correction(const Coefficients &, const Uint & k, const std::vector<Real> & zr, 
+						  const std::vector<Real> & zi, const Complex & p, const Complex & dp) const
+{
+	const Complex	zk{zr[k], zi[k]};
+	const Complex	ratio = p / dp;
+	Complex			sum{0.};
+	
+	for(Uint j = 0u; j < zr.size(); ++j)
+		if(j != k)
+			sum += 1. / (zk - Complex{zr[j], zi[j]});
+	
+	return ratio / (1. - ratio * sum);
+}
+
+
+/*!
+ * Durand-Kerner correction of the k-th root: w = p / (c_0 prod_{j!=k} (z_k - z_j))
+ *
+ */
+
+PolySolverTraits::Complex
+DurandKerner::correction(const Coefficients & c, const Uint & k, const std::vector<Real> & zr, 
+						 const std::vector<Real> & zi, const Complex & p, const Complex &) const
+{
+	const Complex	zk{zr[k], zi[k]};
+	Complex			prod{c[0]};
+	
+	for(Uint j = 0u; j < zr.size(); ++j)
+		if(j != k)
+			prod *= zk - Complex{zr[j], zi[j]};
+	
+	return p / prod;
+}
+
+
+/*!
+ * Builds the polynomial solver described by a MethodConfig
+ *
+ * config --> the parameters of the method (config.name is the name of the method, config.coeff
+ * the coefficients of the polynomial)
+ * It returns nullptr if the method is not valid
+ *
+ */
+
+std::unique_ptr<PolySolverBase>
+PolySolverFactory::make_solver(const MethodConfig & config) const
+{
+	const PolySolverTraits::Coefficients coeff(config.coeff.begin(), config.coeff.end());
+	
+	if(config.name == "AberthEhrlich")
+		return make_solver<AberthEhrlich>(coeff, config.tol, static_cast<PolySolverTraits::Uint>(config.maxIt), config.tola);
+	
+	else if(config.name == "DurandKerner")
+		return make_solver<DurandKerner>(coeff, config.tol, static_cast<PolySolverTraits::Uint>(config.maxIt), config.tola);
+	
+	return nullptr;
+}
@@ -0,0 +1,106 @@
+#ifndef HH__POLY_ZERO_FUN__HH
+#define HH__POLY_ZERO_FUN__HH
+
+#include <complex>
+#include <vector>
+#include <memory>
+#include <string>
+#include "ZeroFun.hpp"
+
+
+// Traits with the types used by the polynomial solvers
+struct PolySolverTraits
+{
+	using Real = double;
+	using Uint = unsigned int;
+	using Complex = std::complex<Real>;
+	using Coefficients = std::vector<Complex>;	// Highest degree first: c[0] x^n + ... + c[n]
+	using Roots = std::vector<Complex>;
+	using PolySolverOutput = std::pair<Roots, bool>;
+};
+
+
+// Abstract base class for methods that find all the (complex) roots of a polynomial simultaneously
+class PolySolverBase: public PolySolverTraits
+{
+	public: PolySolverBase(const Coefficients & coeff_, const Real & tol_, const Uint & maxIt_, const Real & tola_)
+			: coeff(coeff_), tol(tol_), maxIt(maxIt_), tola(tola_) {};
+			
+			PolySolverBase(const Coefficients & coeff_) : coeff(coeff_), tol(1.e-5), maxIt(200), tola(1.e-10) {};
+			
+			inline PolySolverOutput solve() const { return compute(coeff); };
+			
+			std::vector<PolySolverOutput> solve_batch(const std::vector<Coefficients> & batch) const;
+			
+			inline void set_coeff(const Coefficients & coeff_){ coeff = coeff_; };
+			
+			inline Coefficients get_coeff() const { return coeff; };
+			
+			virtual ~PolySolverBase() = default;
+			
+	protected: Coefficients coeff;
+			   const Real tol;
+			   const Uint maxIt;
+			   const Real tola;
+			   
+			   PolySolverOutput compute(const Coefficients & c) const;
+			   
+			   // Correction of the k-th root given p and p' at all the approximations (zr, zi)
+			   virtual Complex correction(const Coefficients & c, const Uint & k, const std::vector<Real> & zr,
+										  const std::vector<Real> & zi, const Complex & p, const Complex & dp) const = 0;
+			   
+			   virtual const char * name() const = 0;
+			   
+			   static Coefficients normalize(const Coefficients & c);
+			   
+			   static void initialGuess(const Coefficients & c, std::vector<Real> & zr, std::vector<Real> & zi);
+			   
+			   static void horner(const Coefficients & c, const std::vector<Real> & zr, const std::vector<Real> & zi,
+								  std::vector<Real> & pr, std::vector<Real> & pi,
+								  std::vector<Real> & dpr, std::vector<Real> & dpi);
+};
+
+
+// Aberth-Ehrlich method
+class AberthEhrlich final: public PolySolverBase
+{
+	public: AberthEhrlich(const Coefficients & coeff_, const Real & tol_, const Uint & maxIt_, const Real & tola_)
+			: PolySolverBase(coeff_, tol_, maxIt_, tola_) {};
+			
+			AberthEhrlich(const Coefficients & coeff_) : PolySolverBase(coeff_) {};
+			
+	private: Complex correction(const Coefficients & c, const Uint & k, const std::vector<Real> & zr,
+								const std::vector<Real> & zi, const Complex & p, const Complex & dp) const override;
+			 
+			 inline const char * name() const override { return "AberthEhrlich::compute"; };
+};
+
+
+// Durand-Kerner (Weierstrass) method
+class DurandKerner final: public PolySolverBase
+{
+	public: DurandKerner(const Coefficients & coeff_, const Real & tol_, const Uint & maxIt_, const Real & tola_)
+			: PolySolverBase(coeff_, tol_, maxIt_, tola_) {};
+			
+			DurandKerner(const Coefficients & coeff_) : PolySolverBase(coeff_) {};
+			
+	private: Complex correction(const Coefficients & c, const Uint & k, const std::vector<Real> & zr,
+								const std::vector<Real> & zi, const Complex & p, const Complex & dp) const override;
+			 
+			 inline const char * name() const override { return "DurandKerner::compute"; };
+};
+
+
+// PolySolverFactory to retrieve a pointer to a polynomial solver object
+class PolySolverFactory
+{
+	public: template<class Solver, class ... Args>
+			std::unique_ptr<PolySolverBase> make_solver(const Args& ... args) const
+			{
+				return std::make_unique<Solver>(args...);
+			}
+			
+			std::unique_ptr<PolySolverBase> make_solver(const MethodConfig & config) const;
+};
+
+#endif
@@ -0,0 +1,199 @@
+#include <iomanip>
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "Profiler.hpp"
+
+
+namespace
+{
+	// Group of hardware counters of the calling thread (the first one is the group leader). A sample holds
+	// the time the group was enabled, the time it was running on the PMU and the four counters
+	class PerfCounters
+	{
+		public: PerfCounters()
+				{
+					constexpr std::array<std::uint64_t, 4> configs{PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+																   PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES};
+					
+					for(unsigned int i = 0u; i < configs.size(); ++i)
+					{
+						perf_event_attr attr;
+						std::memset(&attr, 0, sizeof(attr));
+						attr.type = PERF_TYPE_HARDWARE;
+						attr.size = sizeof(attr);
+						attr.config = configs[i];
+						attr.disabled = (i == 0u) ? 1 : 0;
+						attr.exclude_kernel = 1;
+						attr.exclude_hv = 1;
+						attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+						
+						fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, (i == 0u) ? -1 : fds[0], 0);
+						if(fds[i] < 0)
+						{
+							close_all();
+							return;
+						}
+					}
+					
+					ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+					ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+				}
+				
+				~PerfCounters() { close_all(); }
+				
+				inline bool available() const { return fds[0] >= 0; }
+				
+				bool read_values(std::array<std::uint64_t, 6> & values) const
+				{
+					std::uint64_t buffer[1 + 6];
+					
+					if(!available() || read(fds[0], buffer, sizeof(buffer)) != sizeof(buffer) || buffer[0] != 4u)
+						return false;
+					
+					for(unsigned int i = 0u; i < values.size(); ++i)
+						values[i] = buffer[1 + i];
+					
+					return true;
+				}
+				
+		private: std::array<int, 4> fds{-1, -1, -1, -1};
+		
+				 void close_all()
+				 {
+					for(int & fd : fds)
+					{
+						if(fd >= 0)
+							close(fd);
+						fd = -1;
+					}
+				 }
+	};
+	
+	
+	// The counters are opened once per thread, the first time a kernel is profiled
+	const PerfCounters & thread_counters()
+	{
+		thread_local PerfCounters counters;
+		return counters;
+	}
+}
+
+
+Profiler &
+Profiler::instance()
+{
+	static Profiler profiler;
+	return profiler;
+}
+
+
+/*!
+ * Adds the counters of a profiled call to the summary of its kernel
+ *
+ */
+
+void
+Profiler::record(const std::string & name, const ProfileCounters & counters)
+{
+	std::lock_guard<std::mutex> lock(summary_mutex);
+	ProfileCounters & total = summary[name];
+	
+	total.calls += counters.calls;
+	total.hardware_calls += counters.hardware_calls;
+	total.multiplexed_calls += counters.multiplexed_calls;
+	total.seconds += counters.seconds;
+	total.cycles += counters.cycles;
+	total.instructions += counters.instructions;
+	total.branch_misses += counters.branch_misses;
+	total.cache_misses += counters.cache_misses;
+}
+
+
+/*!
+ * Prints the per-kernel summary, one whitespace separated line per kernel so that the
+ * outputs of different commits can be compared with diff or any table tool
+ * The hardware counters of a kernel refer to its hw-calls calls ("-" if none of them was measured), the
+ * mux-calls of them were multiplexed with other counters and their counts are estimated by scaling
+ * The counters of a kernel are inclusive: they also count the kernels profiled inside its calls
+ *
+ */
+
+void
+Profiler::report(std::ostream & out) const
+{
+	std::lock_guard<std::mutex> lock(summary_mutex);
+	
+	out << "# inclusive counters: a kernel also counts the kernels profiled inside its calls" << std::endl;
+	out << std::left << std::setw(40) << "# kernel" << std::right << std::setw(10) << "calls" << std::setw(10) << "hw-calls"
+		<< std::setw(10) << "mux-calls" << std::setw(14) << "time[s]"
+		<< std::setw(16) << "cycles" << std::setw(16) << "instructions" << std::setw(8) << "IPC" 
+		<< std::setw(16) << "branch-misses" << std::setw(16) << "cache-misses" << std::endl;
+	
+	for(const auto & kernel : summary)
+	{
+		const ProfileCounters & c = kernel.second;
+		
+		out << std::left << std::setw(40) << kernel.first << std::right << std::setw(10) << c.calls
+			<< std::setw(10) << c.hardware_calls << std::setw(10) << c.multiplexed_calls << std::setw(14) << std::scientific << std::setprecision(4) 
+			<< c.seconds << std::defaultfloat;
+		
+		if(c.hardware_calls == 0u)
+		{
+			out << std::setw(16) << "-" << std::setw(16) << "-" << std::setw(8) << "-" << std::setw(16) << "-" 
+				<< std::setw(16) << "-" << std::endl;
+			continue;
+		}
+		
+		out << std::setw(16) << c.cycles << std::setw(16) << c.instructions << std::setw(8) << std::fixed 
+			<< std::setprecision(3) << (c.cycles > 0u ? static_cast<double>(c.instructions) / c.cycles : 0.) 
+			<< std::defaultfloat << std::setw(16) << c.branch_misses << std::setw(16) << c.cache_misses << std::endl;
+	}
+}
+
+
+ScopedProfile::ScopedProfile(const char * name_) : name(name_)
+{
+	Profiler & profiler = Profiler::instance();
+	
+	if(!profiler.is_enabled())
+		return;
+	
+	// Without the counters of this thread only the time is measured
+	active = true;
+	hardware = thread_counters().read_values(start);
+	start_time = std::chrono::steady_clock::now();
+}
+
+
+ScopedProfile::~ScopedProfile()
+{
+	if(!active)
+		return;
+	
+	ProfileCounters					counters;
+	std::array<std::uint64_t, 6>	stop;
+	
+	counters.calls = 1u;
+	counters.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+	
+	// When the PMU is shared with other groups the counters run only for a part of the call: they are
+	// scaled to the whole call and the call is flagged as multiplexed (not measured if they never ran)
+	if(hardware && thread_counters().read_values(stop) && stop[1] > start[1])
+	{
+		const std::uint64_t enabled = stop[0] - start[0];
+		const std::uint64_t running = stop[1] - start[1];
+		const double		scale = static_cast<double>(enabled) / running;
+		
+		counters.hardware_calls = 1u;
+		counters.multiplexed_calls = (running < enabled) ? 1u : 0u;
+		counters.cycles = static_cast<std::uint64_t>((stop[2] - start[2]) * scale);
+		counters.instructions = static_cast<std::uint64_t>((stop[3] - start[3]) * scale);
+		counters.branch_misses = static_cast<std::uint64_t>((stop[4] - start[4]) * scale);
+		counters.cache_misses = static_cast<std::uint64_t>((stop[5] - start[5]) * scale);
+	}
+	
+	Profiler::instance().record(name, counters);
+}
@@ -0,0 +1,75 @@
+#ifndef HH__PROFILER__HH
+#define HH__PROFILER__HH
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+
+// Counters accumulated by the profiler for a kernel
+struct ProfileCounters
+{
+	std::uint64_t calls{0u};
+	std::uint64_t hardware_calls{0u};	// calls measured also by the hardware counters
+	std::uint64_t multiplexed_calls{0u};	// hardware calls whose counters were scaled (multiplexed PMU)
+	double seconds{0.};
+	std::uint64_t cycles{0u};
+	std::uint64_t instructions{0u};
+	std::uint64_t branch_misses{0u};
+	std::uint64_t cache_misses{0u};
+};
+
+
+// Collects the per-kernel summaries of the profiled runs. Hardware counters are read with
+// perf_event_open (Linux): in the threads where they are not available only the wall time is measured
+class Profiler
+{
+	public: static Profiler & instance();
+			
+			void record(const std::string & name, const ProfileCounters & counters);
+			
+			void report(std::ostream & out) const;
+			
+			inline void set_enabled(bool enabled_){ enabled = enabled_; };
+			
+			inline bool is_enabled() const { return enabled; };
+			
+	private: Profiler() = default;
+	
+			 std::atomic<bool> enabled{false};
+			 std::map<std::string, ProfileCounters> summary;
+			 mutable std::mutex summary_mutex;
+};
+
+
+// Measures the kernel in its scope (cycles, instructions, branch-misses, cache-misses and time)
+class ScopedProfile
+{
+	public: ScopedProfile(const char * name_);
+			
+			ScopedProfile(const ScopedProfile &) = delete;
+			ScopedProfile & operator=(const ScopedProfile &) = delete;
+			
+			~ScopedProfile();
+			
+	private: const char * name;
+			 bool active{false};
+			 bool hardware{false};
+			 std::array<std::uint64_t, 6> start;
+			 std::chrono::steady_clock::time_point start_time;
+};
+
+
+// The kernels are profiled only in the builds with ZEROFUN_PROFILE defined (make profile)
+#ifdef ZEROFUN_PROFILE
+#define ZEROFUN_PROFILE_SCOPE(name) ScopedProfile zerofun_profile_scope(name)
+#else
+#define ZEROFUN_PROFILE_SCOPE(name)
+#endif
+
+#endif
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ResultCache.hpp"
+
+
+/*!
+ * Opens (or creates) the memory-mapped cache file
+ * If the file already exists with a valid header its capacity is kept, otherwise it is
+ * (re)initialized with the given capacity
+ *
+ * filename --> name of the cache file
+ * capacity --> maximum number of entries (size limit of the file)
+ * If the file can not be mapped the cache stays closed and every lookup misses
+ *
+ */
+
+ResultCache::ResultCache(const std::string & filename_, const Uint & capacity_)
+: filename(filename_), capacity(capacity_)
+{
+	if(capacity == 0u)
+	{
+		std::cout << "ERROR: the cache must have at least one entry...cache disabled" << std::endl;
+		return;
+	}
+	
+	fd = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if(fd < 0)
+	{
+		std::cout << "ERROR: unable to open the cache file " << filename << "...cache disabled" << std::endl;
+		return;
+	}
+	
+	// Only one process at a time can check and initialize the file
+	flock(fd, LOCK_EX);
+	
+	struct stat st;
+	Header		old_header{0u, 0u, 0u};
+	
+	if(fstat(fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= sizeof(Header))
+		if(pread(fd, &old_header, sizeof(Header), 0) != sizeof(Header))
+			old_header.magic = 0u;
+	
+	bool valid = old_header.magic == magic_number && old_header.capacity > 0u &&
+				 static_cast<std::size_t>(st.st_size) == sizeof(Header) + old_header.capacity * sizeof(Slot);
+	
+	if(valid)
+		capacity = old_header.capacity;
+	
+	table_size = sizeof(Header) + capacity * sizeof(Slot);
+	
+	if(!valid && (ftruncate(fd, 0) != 0 || ftruncate(fd, table_size) != 0))
+	{
+		std::cout << "ERROR: unable to resize the cache file " << filename << "...cache disabled" << std::endl;
+		flock(fd, LOCK_UN);
+		close(fd);
+		fd = -1;
+		return;
+	}
+	
+	void * map = mmap(nullptr, table_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if(map == MAP_FAILED)
+	{
+		std::cout << "ERROR: unable to map the cache file " << filename << "...cache disabled" << std::endl;
+		flock(fd, LOCK_UN);
+		close(fd);
+		fd = -1;
+		return;
+	}
+	
+	table = map;
+	
+	// A new file is filled with zeros, i.e. all the slots are empty
+	if(!valid)
+	{
+		header() -> magic = magic_number;
+		header() -> capacity = capacity;
+		header() -> clock = 0u;
+	}
+	
+	flock(fd, LOCK_UN);
+}
+
+
+ResultCache::~ResultCache()
+{
+	if(table != nullptr)
+		munmap(table, table_size);
+	
+	if(fd >= 0)
+		close(fd);
+}
+
+
+/*!
+ * Hash (FNV-1a) of the signature of a problem
+ * The value 0 is reserved to the empty slots
+ *
+ */
+
+ResultCache::Key
+ResultCache::hash(const std::string & signature)
+{
+	Key h = 0xcbf29ce484222325;
+	
+	for(unsigned char c : signature)
+	{
+		h ^= c;
+		h *= 0x100000001b3;
+	}
+	
+	return (h == 0u) ? 1u : h;
+}
+
+
+/*!
+ * Finds the slot with the given key in its probe window
+ * It returns nullptr if the key is not stored (the caller must hold the file lock)
+ *
+ */
+
+const ResultCache::Slot *
+ResultCache::find(const Key & key) const
+{
+	for(unsigned int i = 0u; i < max_probe && i < capacity; ++i)
+	{
+		const Slot * slot = slots() + (key + i) % capacity;
+		
+		if(slot -> key == key)
+			return slot;
+		
+		if(slot -> key == 0u)
+			return nullptr;
+	}
+	
+	return nullptr;
+}
+
+
+/*!
+ * Looks for the result of a problem in the cache
+ *
+ * key --> hash of the problem signature
+ * warm_key --> hash of the function only, whose result can be reused as a warm start
+ * res --> the cached result (if found)
+ * warm --> true if res is only a warm start
+ * It returns true if the problem or a warm start has been found (both count as hits)
+ * If warm_key is equal to key only the exact problem is looked for
+ *
+ */
+
+bool
+ResultCache::lookup(const Key & key, const Key & warm_key, SolverOutput & res, bool & warm)
+{
+	if(!is_open())
+	{
+		++misses;
+		return false;
+	}
+	
+	flock(fd, LOCK_SH);
+	
+	const Slot * slot = find(key);
+	warm = false;
+	
+	if(slot == nullptr && warm_key != key)
+	{
+		slot = find(warm_key);
+		warm = true;
+	}
+	
+	if(slot != nullptr)
+		res = std::make_pair(slot -> x, slot -> converged != 0u);
+	
+	flock(fd, LOCK_UN);
+	
+	if(slot == nullptr)
+	{
+		warm = false;
+		++misses;
+		return false;
+	}
+	
+	++hits;
+	if(warm)
+		++warm_hits;
+	
+	return true;
+}
+
+
+/*!
+ * Stores the result of a problem in the cache
+ * If the probe window of the key is full, its oldest entry is evicted
+ *
+ * key --> hash of the problem signature
+ * res --> the result of the solver
+ *
+ */
+
+void
+ResultCache::store(const Key & key, const SolverOutput & res)
+{
+	if(!is_open())
+		return;
+	
+	flock(fd, LOCK_EX);
+	
+	Slot *	victim = nullptr;
+	
+	for(unsigned int i = 0u; i < max_probe && i < capacity; ++i)
+	{
+		Slot * slot = slots() + (key + i) % capacity;
+		
+		if(slot -> key == key || slot -> key == 0u)
+		{
+			victim = slot;
+			break;
+		}
+		
+		if(victim == nullptr || slot -> stamp < victim -> stamp)
+			victim = slot;
+	}
+	
+	victim -> key = key;
+	victim -> stamp = ++(header() -> clock);
+	victim -> x = res.first;
+	victim -> converged = res.second ? 1u : 0u;
+	
+	flock(fd, LOCK_UN);
+}
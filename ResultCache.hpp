@@ -0,0 +1,70 @@
+#ifndef HH__RESULT_CACHE__HH
+#define HH__RESULT_CACHE__HH
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "ZeroFun.hpp"
+
+
+// On-disk cache of the results of the solvers, keyed by a hash of the problem signature.
+// The file is memory-mapped and organized as an open-addressing hash table with a fixed
+// number of slots: readers share the file lock, writers take it exclusively
+class ResultCache: public SolverTraits
+{
+	public: using Key = std::uint64_t;
+	
+			ResultCache(const std::string & filename_, const Uint & capacity_);
+			
+			ResultCache(const ResultCache &) = delete;
+			ResultCache & operator=(const ResultCache &) = delete;
+			
+			~ResultCache();
+			
+			bool lookup(const Key & key, const Key & warm_key, SolverOutput & res, bool & warm);
+			
+			void store(const Key & key, const SolverOutput & res);
+			
+			static Key hash(const std::string & signature);
+			
+			inline bool is_open() const { return table != nullptr; };
+			inline std::string get_filename() const { return filename; };
+			inline Uint get_capacity() const { return capacity; };
+			inline Uint get_hits() const { return hits; };
+			inline Uint get_warm_hits() const { return warm_hits; };
+			inline Uint get_misses() const { return misses; };
+			
+	private: struct Header
+			 {
+				std::uint64_t magic;
+				std::uint64_t capacity;
+				std::uint64_t clock;
+			 };
+			 
+			 struct Slot
+			 {
+				Key key;				// 0 if the slot is empty
+				std::uint64_t stamp;	// insertion time, the oldest slot of a probe window is evicted
+				InputType x;
+				std::uint64_t converged;
+			 };
+			 
+			 static constexpr std::uint64_t magic_number = 0x5a45524f46554e31; // "ZEROFUN1"
+			 static constexpr Uint max_probe = 16u;
+			 
+			 const std::string filename;
+			 Uint capacity;
+			 int fd{-1};
+			 void * table{nullptr};
+			 std::size_t table_size{0u};
+			 Uint hits{0u};
+			 Uint warm_hits{0u};
+			 Uint misses{0u};
+			 
+			 inline Header * header() const { return static_cast<Header *>(table); };
+			 inline Slot * slots() const { return reinterpret_cast<Slot *>(header() + 1); };
+			 
+			 const Slot * find(const Key & key) const;
+};
+
+#endif
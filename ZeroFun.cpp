@@ -1,7 +1,12 @@
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <vector>
+#include <numeric>
+#include <algorithm>
 #include "ZeroFun.hpp"
+#include "Profiler.hpp"
+#include "BatchPartition.hpp"
 
 
 /*!
@@ -20,6 +25,7 @@
 std::pair<SolverTraits::Interval, bool>
 SolverBaseInterval::bracketInterval(InputType x1)
 {
+	ZEROFUN_PROFILE_SCOPE("SolverBaseInterval::bracketInterval");
 	
 	constexpr SolverTraits::InputType	expandFactor = 1.5;
 	double								direction = 1.0;
@@ -67,6 +73,8 @@ SolverBaseInterval::bracketInterval(InputType x1)
 std::pair<SolverTraits::Interval, bool>
 SolverBaseInterval::CheckInterval()
 {
+	ZEROFUN_PROFILE_SCOPE("SolverBaseInterval::CheckInterval");
+
 	InputType		a{interval.first};
 	InputType		b{interval.second};
 	OutputType		ya = f(a);
@@ -113,16 +121,34 @@ SolverBaseInterval::CheckInterval()
 SolverTraits::SolverOutput
 Bisection::solve()
 {
+	ZEROFUN_PROFILE_SCOPE("Bisection::solve");
+
 	std::pair<Interval, bool> check_interval = CheckInterval();
 	
 	if(check_interval.second == false)
 		return std::make_pair(std::numeric_limits<InputType>::quiet_NaN(), false);
 	
 	interval = check_interval.first;
-	InputType		a{interval.first};
-	InputType		b{interval.second};
-	OutputType		ya = f(a);
-	OutputType		yb = f(b);
+	
+	return refine(interval, f(interval.first), f(interval.second));
+}
+
+
+/*!
+ * Iterations of the bisection method on an interval that brackets the zero of f, when the values 
+ * of f at its ends are already known (CheckInterval() is not called)
+ *
+ * bracket --> The bracketing interval
+ * ya, yb --> f(bracket.first) and f(bracket.second), with ya * yb <= 0
+ * It returns the approximation of the zero of f and a status (true if converging)
+ *
+ */
+
+SolverTraits::SolverOutput
+Bisection::refine(const Interval & bracket, OutputType ya, OutputType yb)
+{
+	InputType		a{bracket.first};
+	InputType		b{bracket.second};
 	
 	if((ya * yb) == 0.0)
 	{
@@ -173,16 +199,34 @@ Bisection::solve()
 SolverTraits::SolverOutput
 RegulaFalsi::solve()
 {
+	ZEROFUN_PROFILE_SCOPE("RegulaFalsi::solve");
+
 	std::pair<Interval, bool> check_interval = CheckInterval();
 	
 	if(check_interval.second == false)
 		return std::make_pair(std::numeric_limits<InputType>::quiet_NaN(), false);
 	
 	interval = check_interval.first;
-	InputType				a{interval.first};
-	InputType				b{interval.second};
-	OutputType				ya = f(a);
-	OutputType				yb = f(b);
+	
+	return refine(interval, f(interval.first), f(interval.second));
+}
+
+
+/*!
+ * Iterations of the Regula Falsi method on an interval that brackets the zero of f, when the values 
+ * of f at its ends are already known (CheckInterval() is not called)
+ *
+ * bracket --> The bracketing interval
+ * ya, yb --> f(bracket.first) and f(bracket.second), with ya * yb <= 0
+ * It returns the approximation of the zero of f and a status (true if converging)
+ *
+ */
+
+SolverTraits::SolverOutput
+RegulaFalsi::refine(const Interval & bracket, OutputType ya, OutputType yb)
+{
+	InputType				a{bracket.first};
+	InputType				b{bracket.second};
 	
 	if((ya * yb) == 0.0)
 	{
@@ -250,16 +294,34 @@ RegulaFalsi::solve()
 SolverTraits::SolverOutput
 Brent::solve()
 {
+	ZEROFUN_PROFILE_SCOPE("Brent::solve");
+
 	std::pair<Interval, bool> check_interval = CheckInterval();
 	
 	if(check_interval.second == false)
 		return std::make_pair(std::numeric_limits<InputType>::quiet_NaN(), false);
 	
 	interval = check_interval.first;
-	InputType		a{interval.first};
-	InputType		b{interval.second};
-	OutputType		ya = f(a);
-	OutputType		yb = f(b);
+	
+	return refine(interval, f(interval.first), f(interval.second));
+}
+
+
+/*!
+ * Iterations of Brent method on an interval that brackets the zero of f, when the values 
+ * of f at its ends are already known (CheckInterval() is not called)
+ *
+ * bracket --> The bracketing interval
+ * ya, yb --> f(bracket.first) and f(bracket.second), with ya * yb <= 0
+ * It returns the approximation of the zero of f and a status (true if converging)
+ *
+ */
+
+SolverTraits::SolverOutput
+Brent::refine(const Interval & bracket, OutputType ya, OutputType yb)
+{
+	InputType		a{bracket.first};
+	InputType		b{bracket.second};
 
 	if((ya * yb) == 0.0)
 	{
@@ -359,6 +421,8 @@ return std::make_pair(s, (iter < maxIt));
 SolverTraits::SolverOutput
 Secant::solve()
 {
+	ZEROFUN_PROFILE_SCOPE("Secant::solve");
+
 	InputType		a{interval.first};
 	InputType		b{interval.second};
 	OutputType		ya = f(a);
@@ -402,6 +466,8 @@ Secant::solve()
 SolverTraits::SolverOutput
 Newton::solve()
 {  
+	ZEROFUN_PROFILE_SCOPE("Newton::solve");
+
 	InputType		a{x};
 	OutputType		ya = f(a);
 	OutputType		resid = std::abs(ya);
@@ -441,6 +507,8 @@ Newton::solve()
 SolverTraits::SolverOutput
 QuasiNewton::solve()
 {  
+	ZEROFUN_PROFILE_SCOPE("QuasiNewton::solve");
+
 	InputType		a{x};
 	OutputType		ya = f(a);
 	OutputType		resid = std::abs(ya);
@@ -460,3 +528,243 @@ QuasiNewton::solve()
 	return std::make_pair(a, (iter < maxIt));
 }
 
+
+
+/*!
+ * This function samples f at n_samples + 1 equispaced points of the interval and stores
+ * them as a bracket index shared by all the targets of the LevelSet solver
+ *
+ * f --> The function (it must be monotone on the interval)
+ * interval.first --> First end of the sampled interval
+ * interval.second --> Second end of the sampled interval
+ * n_samples --> number of sub-intervals
+ * It returns true if the samples are monotone (index valid)
+ *
+ */
+
+bool
+LevelSetSolver::buildIndex()
+{
+	ZEROFUN_PROFILE_SCOPE("LevelSetSolver::buildIndex");
+
+	samples_x.clear();
+	samples_y.clear();
+
+	if(n_samples == 0u)
+	{
+		std::cout << "ERROR: at least one sub-interval is needed to sample the function" << std::endl;
+		return false;
+	}
+
+	InputType		a{std::min(interval.first, interval.second)};
+	InputType		b{std::max(interval.first, interval.second)};
+	InputType		h = (b - a) / n_samples;
+	
+	samples_x.reserve(n_samples + 1);
+	samples_y.reserve(n_samples + 1);
+	
+	for(unsigned int k = 0u; k <= n_samples; ++k)
+	{
+		InputType x = (k == n_samples) ? b : a + k * h;
+		samples_x.push_back(x);
+		samples_y.push_back(f(x));
+	}
+	
+	// Increasing or decreasing function
+	orientation = (samples_y.back() >= samples_y.front()) ? 1.0 : -1.0;
+	
+	for(unsigned int k = 0u; k < n_samples; ++k)
+		if(orientation * (samples_y[k + 1] - samples_y[k]) < 0.0)
+		{
+			std::cout << "ERROR: the function is not monotone on the interval" << std::endl;
+			samples_x.clear();
+			samples_y.clear();
+			return false;
+		}
+	
+	return true;
+}
+
+
+/*!
+ * Computes x such that f(x) = y for every y in targets
+ *
+ * f --> The function (it must be monotone on the interval)
+ * targets --> The values y
+ * tol --> Tolerance
+ * maxIt --> maximum number of iterations for each target
+ * It returns, in the same order of targets, the approximations of the solutions and 
+ * a status (false if not converging or if the target is out of the range of f)
+ *
+ */
+
+template<class Solver>
+std::vector<SolverTraits::SolverOutput>
+LevelSetSolver::solve(const std::vector<OutputType> & targets)
+{
+	std::vector<InputType>		x(targets.size());
+	std::unique_ptr<bool[]>		converged(new bool[targets.size()]);
+	std::vector<SolverOutput>	res(targets.size());
+	
+	solve<Solver>(targets.data(), x.data(), converged.get(), targets.size());
+	
+	for(std::size_t i = 0u; i < targets.size(); ++i)
+		res[i] = std::make_pair(x[i], converged[i]);
+	
+	return res;
+}
+
+
+/*!
+ * Computes x such that f(x) = y for every y in targets, for very large batches
+ * The batch is split in blocks fitting in the cache (block_size lanes, if 0 it is computed from
+ * the L2 size) which are solved by a team of n_threads OpenMP threads bound to the OpenMP places
+ * (0 = default number of threads): each thread processes the same contiguous range of blocks of
+ * BatchPartition, so arrays first touched through a BatchPartition with the same parameters stay
+ * on its NUMA node
+ *
+ * targets --> The values y (n values)
+ * x --> The approximations of the solutions (NaN if not found)
+ * converged --> The status of each target (false if not converging or out of the range of f)
+ * It returns false if the bracket index can not be built (f not monotone)
+ *
+ */
+
+template<class Solver>
+bool
+LevelSetSolver::solve(const OutputType * targets, InputType * x, bool * converged, const std::size_t & n)
+{
+	ZEROFUN_PROFILE_SCOPE("LevelSetSolver::solve");
+
+	if(samples_x.empty() && !buildIndex())
+	{
+		std::fill(x, x + n, std::numeric_limits<InputType>::quiet_NaN());
+		std::fill(converged, converged + n, false);
+		return false;
+	}
+	
+	// A lane uses its target, its solution, its status and its position in the sorted block
+	const std::size_t		block = (block_size > 0u) ? block_size : 
+								BatchPartition::cache_block_size(sizeof(OutputType) + sizeof(InputType) + 
+																 sizeof(bool) + sizeof(std::size_t));
+	const BatchPartition	partition(n, block, n_threads);
+	
+	partition.run([this, targets, x, converged](std::size_t begin, std::size_t end)
+				  { solveBlock<Solver>(targets + begin, x + begin, converged + begin, end - begin); });
+	
+	return true;
+}
+
+
+/*!
+ * Solves a block of targets, which stays in the cache until all its lanes are done
+ * The targets of the block are sorted and swept once against the bracket index (from the bracket
+ * of the first target), then each of them is refined with the same Solver object (Bisection or
+ * Brent) in its own bracket, starting from the values of f already sampled at its ends
+ *
+ */
+
+template<class Solver>
+void
+LevelSetSolver::solveBlock(const OutputType * targets, InputType * x, bool * converged, const std::size_t & n) const
+{
+	ZEROFUN_PROFILE_SCOPE("LevelSetSolver::solveBlock");
+
+	// Sort the targets along the orientation of f (the NaN targets can not be ordered nor found)
+	std::vector<std::size_t> order;
+	order.reserve(n);
+	
+	for(std::size_t i = 0u; i < n; ++i)
+	{
+		if(std::isnan(targets[i]))
+		{
+			x[i] = std::numeric_limits<InputType>::quiet_NaN();
+			converged[i] = false;
+		}
+		else
+			order.push_back(i);
+	}
+	
+	std::sort(order.begin(), order.end(), [this, targets](std::size_t i, std::size_t j)
+										  { return orientation * targets[i] < orientation * targets[j]; });
+	
+	// The solver refines f(x) - y in the bracket of y, whose values of f are known from the samples
+	OutputType		y{0.};
+	Solver			solver([this, &y](const InputType & z){ return f(z) - y; }, tol, maxIt, 
+						   Interval{samples_x.front(), samples_x.back()}, 0u, samples_x[1] - samples_x[0]);
+	std::size_t		k{0u};
+	
+	// The sweep of the block starts from the bracket of its first target, found by bisection on the samples
+	if(!order.empty())
+	{
+		const OutputType oy = orientation * targets[order.front()];
+		k = std::partition_point(samples_y.begin() + 1, samples_y.begin() + n_samples, 
+								 [this, oy](const OutputType & s){ return orientation * s < oy; }) - samples_y.begin() - 1;
+	}
+	
+	for(std::size_t i : order)
+	{
+		y = targets[i];
+		OutputType oy = orientation * y;
+		
+		while(k + 1 < n_samples && orientation * samples_y[k + 1] < oy)
+			++k;
+		
+		if(oy < orientation * samples_y[k] || oy > orientation * samples_y[k + 1])
+		{
+			x[i] = std::numeric_limits<InputType>::quiet_NaN();
+			converged[i] = false;
+			continue;
+		}
+		
+		SolverOutput res = solver.refine(Interval{samples_x[k], samples_x[k + 1]}, samples_y[k] - y, samples_y[k + 1] - y);
+		x[i] = res.first;
+		converged[i] = res.second;
+	}
+}
+
+template std::vector<SolverTraits::SolverOutput> LevelSetSolver::solve<Bisection>(const std::vector<OutputType> &);
+template std::vector<SolverTraits::SolverOutput> LevelSetSolver::solve<Brent>(const std::vector<OutputType> &);
+template bool LevelSetSolver::solve<Bisection>(const OutputType *, InputType *, bool *, const std::size_t &);
+template bool LevelSetSolver::solve<Brent>(const OutputType *, InputType *, bool *, const std::size_t &);
+
+
+/*!
+ * Builds the solver described by a MethodConfig
+ *
+ * config --> the parameters of the method (config.name is the name of the method)
+ * f --> The function
+ * df --> The derivative of the function (used only by Newton)
+ * It returns nullptr if the method is not valid
+ *
+ */
+
+std::unique_ptr<SolverBase>
+SolverFactory::make_solver(const MethodConfig & config, SolverTraits::FunType f, SolverTraits::FunType df) const
+{
+	const SolverTraits::Uint	maxIt = static_cast<SolverTraits::Uint>(config.maxIt);
+	const SolverTraits::Uint	maxIt_interval = static_cast<SolverTraits::Uint>(config.maxIt_interval);
+	
+	if(config.name == "Bisection")
+		return make_solver<Bisection>(f, config.tol, maxIt, config.interval, maxIt_interval,
+									  config.h_interval);
+
+	else if(config.name == "RegulaFalsi")
+		return make_solver<RegulaFalsi>(f, config.tol, maxIt, config.tola, config.interval, 
+										maxIt_interval, config.h_interval);
+
+	else if(config.name == "Brent")
+		return make_solver<Brent>(f, config.tol, maxIt, config.interval, maxIt_interval, 
+								  config.h_interval);
+
+	else if(config.name == "Secant")
+		return make_solver<Secant>(f, config.tol, maxIt, config.tola, config.interval);
+
+	else if(config.name == "Newton")
+		return make_solver<Newton>(f, config.tol, maxIt, config.tola, config.x, df);
+
+	else if(config.name == "QuasiNewton")
+		return make_solver<QuasiNewton>(f, config.tol, maxIt, config.tola, config.x, config.h);
+
+	return nullptr;
+}
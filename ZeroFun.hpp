@@ -5,6 +5,7 @@
 #include <functional>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 
 // Traits with the types used in the child classes
@@ -20,6 +21,33 @@ struct SolverTraits
 };
 
 
+// Parameters of a method (the ones not used by the method are ignored). The counts are signed as
+// read from the data file: they are checked by ZeroFunConfig::validate() and then converted to Uint
+struct MethodConfig: public SolverTraits
+{
+	std::string name;
+	std::string label;			// name of the configuration: the method, or <method>.<suffix>
+	Real tol{1.e-5};
+	int maxIt{200};
+	Real tola{1.e-10};
+	InputType x{0.0};
+	Interval interval{0.0, 1.0};
+	InputType h{1.e-2};
+	int maxIt_interval{200};
+	InputType h_interval{0.1};
+	
+	// LevelSet parameters
+	std::string refine{"Brent"};
+	int n_samples{100};
+	std::vector<OutputType> targets;
+	int n_threads{1};			// 0 = default number of OpenMP threads
+	int block_size{0};			// 0 = from the size of the cache
+	
+	// Coefficients of the polynomial (highest degree first) for AberthEhrlich and DurandKerner
+	std::vector<Real> coeff;
+};
+
+
 // Abstract base class for methods that find the zero of a function
 class SolverBase: public SolverTraits
 {
@@ -54,6 +82,8 @@ class SolverBaseInterval: public SolverBase
 			
 			virtual SolverOutput solve() = 0;
 			
+			virtual SolverOutput refine(const Interval & bracket, OutputType ya, OutputType yb) = 0;
+			
 			inline void set_interval(Interval interval_){ interval = interval_; };
 			inline void set_h_interval(InputType h_interval_){ h_interval = h_interval_; };
 			
@@ -83,6 +113,8 @@ class Bisection final: public SolverBaseInterval
 			: SolverBaseInterval(f_, interval_) {};
 	
 			SolverOutput solve() override;
+			
+			SolverOutput refine(const Interval & bracket, OutputType ya, OutputType yb) override;
 
 };
 
@@ -99,6 +131,8 @@ class RegulaFalsi final: public SolverBaseInterval
 			: SolverBaseInterval(f_, interval_), tola(1.e-10) {};
 	
 			SolverOutput solve() override;
+			
+			SolverOutput refine(const Interval & bracket, OutputType ya, OutputType yb) override;
 				
 	private: const Real tola;
 };
@@ -116,6 +150,8 @@ class Brent final: public SolverBaseInterval
 			: SolverBaseInterval(f_, interval_) {};
 	
 			SolverOutput solve() override;
+			
+			SolverOutput refine(const Interval & bracket, OutputType ya, OutputType yb) override;
 
 };
 
@@ -206,6 +242,59 @@ class QuasiNewton final: public Newton
 };
 
 
+// LevelSet solver to find x such that f(x) = y for many targets y sharing a single bracketing of f
+class LevelSetSolver: public SolverTraits
+{
+	public: LevelSetSolver(FunType f_, const Real & tol_, const Uint & maxIt_, const Interval & interval_,
+			const Uint & n_samples_)
+			: f(f_), tol(tol_), maxIt(maxIt_), interval(interval_), n_samples(n_samples_) {};
+			
+			LevelSetSolver(FunType f_, const MethodConfig & config)
+			: f(f_), tol(config.tol), maxIt(static_cast<Uint>(config.maxIt)), interval(config.interval), 
+			  n_samples(static_cast<Uint>(config.n_samples)), n_threads(static_cast<Uint>(config.n_threads)), 
+			  block_size(static_cast<std::size_t>(config.block_size)) {};
+			
+			LevelSetSolver(FunType f_, const Interval & interval_)
+			: f(f_), tol(1.e-5), maxIt(200), interval(interval_), n_samples(100) {};
+			
+			template<class Solver>
+			std::vector<SolverOutput> solve(const std::vector<OutputType> & targets);
+			
+			template<class Solver>
+			bool solve(const OutputType * targets, InputType * x, bool * converged, const std::size_t & n);
+			
+			inline void set_f(FunType f_){ f = f_; samples_x.clear(); };
+			inline void set_interval(Interval interval_){ interval = interval_; samples_x.clear(); };
+			inline void set_n_samples(Uint n_samples_){ n_samples = n_samples_; samples_x.clear(); };
+			inline void set_n_threads(Uint n_threads_){ n_threads = n_threads_; };
+			inline void set_block_size(std::size_t block_size_){ block_size = block_size_; };
+			
+			inline FunType get_f() const { return f; };
+			inline Interval get_interval() const { return interval; };
+			inline Uint get_n_samples() const { return n_samples; };
+			inline Uint get_n_threads() const { return n_threads; };
+			inline std::size_t get_block_size() const { return block_size; };
+			
+	private: FunType f;
+			 const Real tol;
+			 const Uint maxIt;
+			 Interval interval;
+			 Uint n_samples;
+			 Uint n_threads{1u};
+			 std::size_t block_size{0u};
+			 
+			 // Bracket index: samples of f on interval (rebuilt only when f or the sampling change)
+			 std::vector<InputType> samples_x;
+			 std::vector<OutputType> samples_y;
+			 Real orientation{1.0};
+			 
+			 bool buildIndex();
+			 
+			 template<class Solver>
+			 void solveBlock(const OutputType * targets, InputType * x, bool * converged, const std::size_t & n) const;
+};
+
+
 // SolverFactory to retrieve a pointer to a solver method object
 class SolverFactory
 {
@@ -215,6 +304,9 @@ class SolverFactory
 			{
 				return std::make_unique<Solver>(args...);
 			}
+			
+			std::unique_ptr<SolverBase> make_solver(const MethodConfig & config, SolverTraits::FunType f, 
+													SolverTraits::FunType df) const;
 };
 
 #endif
@@ -0,0 +1,387 @@
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "ZeroFunConfig.hpp"
+#include "GetPot"
+
+
+const std::vector<std::string> ZeroFunConfig::method_names{"Bisection", "RegulaFalsi", "Brent", "Secant", "Newton",
+														   "QuasiNewton", "LevelSet", "AberthEhrlich", "DurandKerner"};
+
+
+/*!
+ * Reads the configuration of all the methods
+ * If the binary file is up to date with the data file it is loaded, otherwise the data 
+ * file is parsed with GetPot and the binary file is (re)written
+ *
+ * filename --> name of the data file
+ *
+ */
+
+ZeroFunConfig::ZeroFunConfig(const std::string & filename_) : filename(filename_)
+{
+	struct stat		st;
+	std::int64_t	mtime{-1};
+	
+	if(stat(filename.c_str(), &st) == 0)
+		mtime = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+	
+	binary = mtime >= 0 && read_binary(mtime);
+	
+	if(!binary)
+	{
+		parse();
+		if(mtime >= 0)
+			write_binary(mtime);
+	}
+}
+
+
+/*!
+ * Parses the data file with GetPot (missing parameters take their default value)
+ *
+ */
+
+void
+ZeroFunConfig::parse()
+{
+	GetPot				datafile(filename.c_str());
+	const std::string	section = "ZeroFun/";
+	const Real			tol = datafile((section + "tol").data(), 1.e-5);
+	const int			maxIt = datafile((section + "maxIt").data(), 200);
+	
+	sol_ex = datafile((section + "sol_ex").data(), std::numeric_limits<InputType>::quiet_NaN());
+	cache_file = datafile((section + "cache_file").data(), "");
+	cache_size = std::max(datafile((section + "cache_size").data(), 4096), 0);	// 0 disables the cache
+	
+	// A configuration for every method, plus one for every section named <method>.<suffix>
+	std::vector<std::string> labels(method_names);
+	
+	for(const std::string & subsection : datafile.get_section_names())
+	{
+		if(subsection.compare(0, section.size(), section) != 0 || subsection.size() <= section.size() + 1)
+			continue;
+		
+		const std::string	label = subsection.substr(section.size(), subsection.size() - section.size() - 1);
+		const std::size_t	dot = label.find('.');
+		
+		if(dot != std::string::npos && label.find('/') == std::string::npos &&
+		   std::find(method_names.begin(), method_names.end(), label.substr(0, dot)) != method_names.end())
+			labels.push_back(label);
+	}
+	
+	methods.clear();
+	
+	for(const std::string & label : labels)
+	{
+		const std::string	subsection{section + label + "/"};
+		MethodConfig		config;
+		
+		config.name = label.substr(0, label.find('.'));
+		config.label = label;
+		config.tol = tol;
+		config.maxIt = maxIt;
+		config.tola = datafile((subsection + "tola").data(), config.tola);
+		config.x = datafile((subsection + "x").data(), config.x);
+		config.interval.first = datafile((subsection + "a").data(), config.interval.first);
+		config.interval.second = datafile((subsection + "b").data(), config.interval.second);
+		config.h = datafile((subsection + "h").data(), config.h);
+		config.maxIt_interval = datafile((subsection + "maxIt_interval").data(), config.maxIt_interval);
+		config.h_interval = datafile((subsection + "h_interval").data(), config.h_interval);
+		config.refine = datafile((subsection + "refine").data(), "Brent");
+		config.n_samples = datafile((subsection + "n_samples").data(), config.n_samples);
+		config.n_threads = datafile((subsection + "n_threads").data(), config.n_threads);
+		config.block_size = datafile((subsection + "block_size").data(), config.block_size);
+		
+		config.targets.resize(datafile.vector_variable_size((subsection + "targets").data()));
+		for(unsigned int i = 0u; i < config.targets.size(); ++i)
+			config.targets[i] = datafile((subsection + "targets").data(), 0.0, i);
+		
+		config.coeff.resize(datafile.vector_variable_size((subsection + "coeff").data()));
+		for(unsigned int i = 0u; i < config.coeff.size(); ++i)
+			config.coeff[i] = datafile((subsection + "coeff").data(), 0.0, i);
+		
+		methods[label] = config;
+	}
+}
+
+
+// Helpers to read and write the binary file
+namespace
+{
+	template<class T>
+	void write_value(std::ofstream & out, const T & value)
+	{
+		out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+	}
+	
+	void write_value(std::ofstream & out, const std::string & value)
+	{
+		write_value(out, static_cast<std::uint64_t>(value.size()));
+		out.write(value.data(), value.size());
+	}
+	
+	template<class T>
+	void read_value(std::ifstream & in, T & value)
+	{
+		in.read(reinterpret_cast<char *>(&value), sizeof(T));
+	}
+	
+	void read_value(std::ifstream & in, std::string & value)
+	{
+		std::uint64_t size{0u};
+		read_value(in, size);
+		if(!in || size > (1u << 20))
+		{
+			in.setstate(std::ios::failbit);
+			return;
+		}
+		value.resize(size);
+		in.read(&value[0], size);
+	}
+}
+
+
+/*!
+ * Loads the configuration from the binary file
+ *
+ * mtime --> modification time of the data file (nanoseconds)
+ * It returns false if the binary file is missing, corrupted or out of date
+ *
+ */
+
+bool
+ZeroFunConfig::read_binary(const std::int64_t & mtime)
+{
+	std::ifstream	in(filename + ".bin", std::ios::binary);
+	std::uint64_t	magic{0u};
+	std::int64_t	stored_mtime{-1};
+	
+	read_value(in, magic);
+	read_value(in, stored_mtime);
+	
+	if(!in || magic != magic_number || stored_mtime != mtime)
+		return false;
+	
+	read_value(in, sol_ex);
+	read_value(in, cache_file);
+	read_value(in, cache_size);
+	
+	std::uint64_t n_configs{0u};
+	read_value(in, n_configs);
+	
+	if(!in || n_configs > (1u << 16))
+		return false;
+	
+	methods.clear();
+	
+	for(std::uint64_t i = 0u; i < n_configs; ++i)
+	{
+		MethodConfig	config;
+		std::uint64_t	n_targets{0u};
+		std::uint64_t	n_coeff{0u};
+		
+		read_value(in, config.name);
+		read_value(in, config.label);
+		read_value(in, config.tol);
+		read_value(in, config.maxIt);
+		read_value(in, config.tola);
+		read_value(in, config.x);
+		read_value(in, config.interval.first);
+		read_value(in, config.interval.second);
+		read_value(in, config.h);
+		read_value(in, config.maxIt_interval);
+		read_value(in, config.h_interval);
+		read_value(in, config.refine);
+		read_value(in, config.n_samples);
+		read_value(in, config.n_threads);
+		read_value(in, config.block_size);
+		read_value(in, n_targets);
+		
+		if(!in || n_targets > (1u << 24))
+			return false;
+		
+		config.targets.resize(n_targets);
+		in.read(reinterpret_cast<char *>(config.targets.data()), n_targets * sizeof(OutputType));
+		
+		read_value(in, n_coeff);
+		if(!in || n_coeff > (1u << 24))
+			return false;
+		
+		config.coeff.resize(n_coeff);
+		in.read(reinterpret_cast<char *>(config.coeff.data()), n_coeff * sizeof(Real));
+		
+		methods[config.label] = config;
+	}
+	
+	return static_cast<bool>(in);
+}
+
+
+/*!
+ * Stores the configuration in the binary file
+ * The file is written aside and then renamed, so that concurrent runs never read it half written
+ *
+ * mtime --> modification time of the data file (nanoseconds)
+ *
+ */
+
+void
+ZeroFunConfig::write_binary(const std::int64_t & mtime) const
+{
+	const std::string	tmp_filename = filename + ".bin." + std::to_string(getpid());
+	std::ofstream		out(tmp_filename, std::ios::binary);
+	
+	write_value(out, magic_number);
+	write_value(out, mtime);
+	write_value(out, sol_ex);
+	write_value(out, cache_file);
+	write_value(out, cache_size);
+	
+	write_value(out, static_cast<std::uint64_t>(methods.size()));
+	
+	for(const auto & method : methods)
+	{
+		const MethodConfig & config = method.second;
+		
+		write_value(out, config.name);
+		write_value(out, config.label);
+		write_value(out, config.tol);
+		write_value(out, config.maxIt);
+		write_value(out, config.tola);
+		write_value(out, config.x);
+		write_value(out, config.interval.first);
+		write_value(out, config.interval.second);
+		write_value(out, config.h);
+		write_value(out, config.maxIt_interval);
+		write_value(out, config.h_interval);
+		write_value(out, config.refine);
+		write_value(out, config.n_samples);
+		write_value(out, config.n_threads);
+		write_value(out, config.block_size);
+		write_value(out, static_cast<std::uint64_t>(config.targets.size()));
+		out.write(reinterpret_cast<const char *>(config.targets.data()), config.targets.size() * sizeof(OutputType));
+		write_value(out, static_cast<std::uint64_t>(config.coeff.size()));
+		out.write(reinterpret_cast<const char *>(config.coeff.data()), config.coeff.size() * sizeof(Real));
+	}
+	
+	out.close();
+	
+	if(!out || std::rename(tmp_filename.c_str(), (filename + ".bin").c_str()) != 0)
+		std::remove(tmp_filename.c_str());
+}
+
+
+/*!
+ * It returns the configuration with the given label (a method, or <method>.<suffix>),
+ * nullptr if there is no such configuration
+ *
+ */
+
+const MethodConfig *
+ZeroFunConfig::get(const std::string & method) const
+{
+	auto it = methods.find(method);
+	return (it == methods.end()) ? nullptr : &(it -> second);
+}
+
+
+/*!
+ * Checks that the parameters of a method are admissible
+ * It returns false (and prints the reason) if they are not
+ *
+ */
+
+bool
+ZeroFunConfig::validate(const std::string & method) const
+{
+	const MethodConfig * config = get(method);
+	
+	if(config == nullptr)
+	{
+		std::cout << "ERROR: invalid method " << method << std::endl;
+		return false;
+	}
+	
+	bool valid{true};
+	
+	if(!(config -> tol > 0.))
+	{
+		std::cout << "ERROR: tol must be positive" << std::endl;
+		valid = false;
+	}
+	
+	if(config -> maxIt <= 0)
+	{
+		std::cout << "ERROR: maxIt must be positive" << std::endl;
+		valid = false;
+	}
+	
+	if(config -> maxIt_interval < 0)
+	{
+		std::cout << "ERROR: " << method << "/maxIt_interval must be non negative" << std::endl;
+		valid = false;
+	}
+	
+	if(!(config -> tola >= 0.))
+	{
+		std::cout << "ERROR: " << method << "/tola must be non negative" << std::endl;
+		valid = false;
+	}
+	
+	const std::string &	name = config -> name;
+	const bool			polynomial = name == "AberthEhrlich" || name == "DurandKerner";
+	
+	if(config -> interval.first == config -> interval.second && name != "Newton" && name != "QuasiNewton" &&
+	   !polynomial)
+	{
+		std::cout << "ERROR: " << method << "/a and " << method << "/b must be different" << std::endl;
+		valid = false;
+	}
+	
+	if(!(config -> h > 0.) && name == "QuasiNewton")
+	{
+		std::cout << "ERROR: " << method << "/h must be positive" << std::endl;
+		valid = false;
+	}
+	
+	if(!(config -> h_interval > 0.) && (name == "Bisection" || name == "RegulaFalsi" || name == "Brent"))
+	{
+		std::cout << "ERROR: " << method << "/h_interval must be positive" << std::endl;
+		valid = false;
+	}
+	
+	if(name == "LevelSet")
+	{
+		if(config -> n_samples <= 0)
+		{
+			std::cout << "ERROR: " << method << "/n_samples must be positive" << std::endl;
+			valid = false;
+		}
+		
+		if(config -> n_threads < 0 || config -> block_size < 0)
+		{
+			std::cout << "ERROR: " << method << "/n_threads and " << method << "/block_size must be non negative" 
+					  << std::endl;
+			valid = false;
+		}
+		
+		if(config -> refine != "Bisection" && config -> refine != "Brent")
+		{
+			std::cout << "ERROR: invalid refinement method for LevelSet" << std::endl;
+			valid = false;
+		}
+	}
+	
+	if(polynomial && (config -> coeff.empty() || config -> coeff.front() == 0.))
+	{
+		std::cout << "ERROR: " << method << "/coeff must have a non zero leading coefficient" << std::endl;
+		valid = false;
+	}
+	
+	return valid;
+}
@@ -0,0 +1,46 @@
+#ifndef HH__ZERO_FUN_CONFIG__HH
+#define HH__ZERO_FUN_CONFIG__HH
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <limits>
+#include "ZeroFun.hpp"
+
+
+// Configuration of all the methods, parsed once from the ZeroFun section of the data file. Besides
+// the section of each method, a section [./<method>.<suffix>] adds another configuration of the method.
+// The parsed values are stored in a binary file (data file name + ".bin") which is reused
+// as long as the modification time of the data file does not change
+class ZeroFunConfig: public SolverTraits
+{
+	public: ZeroFunConfig(const std::string & filename_);
+	
+			bool validate(const std::string & method) const;
+			
+			const MethodConfig * get(const std::string & method) const;
+			
+			inline std::string get_filename() const { return filename; };
+			inline InputType get_sol_ex() const { return sol_ex; };
+			inline std::string get_cache_file() const { return cache_file; };
+			inline Uint get_cache_size() const { return cache_size; };
+			inline bool from_binary() const { return binary; };
+			
+			static const std::vector<std::string> method_names;
+			
+	private: const std::string filename;
+			 InputType sol_ex{std::numeric_limits<InputType>::quiet_NaN()};
+			 std::string cache_file;
+			 Uint cache_size{4096};
+			 std::map<std::string, MethodConfig> methods;
+			 bool binary{false};
+			 
+			 static constexpr std::uint64_t magic_number = 0x5a46434f4e464935; // "ZFCONFI5"
+			 
+			 void parse();
+			 bool read_binary(const std::int64_t & mtime);
+			 void write_binary(const std::int64_t & mtime) const;
+};
+
+#endif
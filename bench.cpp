@@ -0,0 +1,121 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <atomic>
+#include <unistd.h>
+
+#include "ZeroFun.hpp"
+#include "BatchPartition.hpp"
+
+
+// The function to invert in the benchmark (the same of main)
+double myfun(const double & x)
+{
+	return 0.5 - std::exp(M_PI * x);
+}
+
+
+// Target of the i-th lane, in the range of myfun on [-2, 1] (computed from i so that any thread can initialize it)
+double target(const std::size_t & i)
+{
+	std::uint64_t h = i * 0x9e3779b97f4a7c15;
+	h ^= h >> 31;
+	return 0.49 - 22. * static_cast<double>(h >> 11) / static_cast<double>(1ull << 53);
+}
+
+
+// Scaling of the batched LevelSet solve from 1 to all the NUMA nodes of the machine
+int main(int argc, char **argv)
+{
+	// Unless given by the user, the OpenMP places are the CPUs node by node, so that the threads bound
+	// with proc_bind(close) fill the first nodes. The OpenMP runtime reads OMP_PLACES when it is loaded,
+	// so the benchmark is executed again with the variable in its environment
+	if(std::getenv("OMP_PLACES") == nullptr)
+	{
+		std::string places;
+		
+		for(int cpu : BatchPartition::node_cpus(BatchPartition::n_nodes()))
+			places += (places.empty() ? "{" : ",{") + std::to_string(cpu) + "}";
+		
+		setenv("OMP_PLACES", places.c_str(), 1);
+		execv("/proc/self/exe", argv);
+		
+		std::cout << "ERROR: unable to execute the benchmark again with OMP_PLACES=" << places 
+				  << ", set it before running " << argv[0] << std::endl;
+		return 1;
+	}
+	
+	const unsigned int				nodes = BatchPartition::n_nodes();
+	const std::size_t				n = (argc > 1) ? std::stoull(argv[1]) : 10000000u;
+	const SolverTraits::Uint		n_samples = (argc > 2) ? std::stoul(argv[2]) : 1000u;
+	const std::size_t				block = BatchPartition::cache_block_size(2 * sizeof(double) + sizeof(bool) + sizeof(std::size_t));
+	double							time_1{0.};
+	
+	std::cout << "Batched LevelSet (Brent) of " << n << " targets, blocks of " << block << " targets" << std::endl;
+	std::cout << std::setw(8) << "nodes" << std::setw(10) << "threads" << std::setw(14) << "time[s]"
+			  << std::setw(16) << "targets/s" << std::setw(10) << "speedup" << std::setw(12) << "failed" << std::endl;
+	
+	for(unsigned int n_nodes = 1u; n_nodes <= nodes; ++n_nodes)
+	{
+		const unsigned int		n_threads = BatchPartition::node_cpus(n_nodes).size();
+		const BatchPartition	partition(n, block, n_threads);
+		
+		// The arrays are not initialized by new, the first touch is done by the bound threads
+		std::unique_ptr<double[]>	targets(new double[n]);
+		std::unique_ptr<double[]>	x(new double[n]);
+		std::unique_ptr<bool[]>		converged(new bool[n]);
+		
+		// The scaling over the nodes means nothing if the threads are not bound to the places
+		std::atomic<bool>			unbound{false};
+		
+		partition.run([&targets, &x, &converged, &unbound](std::size_t begin, std::size_t end)
+					  {
+#ifdef _OPENMP
+						if(omp_get_place_num() < 0)
+							unbound = true;
+#endif
+						for(std::size_t i = begin; i < end; ++i)
+						{
+							targets[i] = target(i);
+							x[i] = 0.;
+							converged[i] = false;
+						}
+					  });
+		
+		if(unbound)
+		{
+			std::cout << "ERROR: the threads are not bound to the OpenMP places (OMP_PLACES=" << std::getenv("OMP_PLACES")
+					  << "), the scaling over the nodes is not reported" << std::endl;
+			return 1;
+		}
+		
+		LevelSetSolver level_set(myfun, 1.e-10, 200, SolverTraits::Interval{-2., 1.}, n_samples);
+		level_set.set_block_size(block);
+		level_set.set_n_threads(n_threads);
+		
+		// The bracket index is built out of the timing
+		level_set.solve<Brent>(targets.get(), x.get(), converged.get(), std::min<std::size_t>(n, 1u));
+		
+		auto start = std::chrono::steady_clock::now();
+		level_set.solve<Brent>(targets.get(), x.get(), converged.get(), n);
+		const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		
+		std::size_t failed{0u};
+		for(std::size_t i = 0u; i < n; ++i)
+			if(!converged[i] || std::abs(myfun(x[i]) - targets[i]) > 1.e-6)
+				++failed;
+		
+		if(n_nodes == 1u)
+			time_1 = time;
+		
+		std::cout << std::setw(8) << n_nodes << std::setw(10) << n_threads << std::setw(14) << time
+				  << std::setw(16) << n / time << std::setw(10) << time_1 / time << std::setw(12) << failed << std::endl;
+	}
+	
+	return 0;
+}
@@ -2,10 +2,20 @@
 #include <cmath>
 #include <memory>
 #include <string>
-#include <limits>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <fstream>
 
 #include "ZeroFun.hpp"
-#include "GetPot"
+#include "ResultCache.hpp"
+#include "ZeroFunConfig.hpp"
+#include "PolyZeroFun.hpp"
+#include "Profiler.hpp"
+
+
+// Identifier of the function for which we want the zero (it keys the result cache)
+const std::string function_id = "myfun";
 
 
 // The function for which we want the zero
@@ -22,65 +32,128 @@ double mydfun(const double & x)
 }
 
 
-// Compute the zero of a function with the method in input
-int main(int argc, char **argv)
+// Solve f(x) = y for all the targets of the LevelSet method sharing the same bracketing of f
+int solve_level_set(const MethodConfig & config)
 {
-	// Read in input from command line the datafile name and the method to use
-	GetPot cl(argc, argv);
-	
-	const std::string filename = cl.follow("data", 2, "-f", "--file");
-	const std::string method_name = cl("method", "Bisection"); 
-
-	// Read constant parameter in input from datafile
-	GetPot datafile(filename.c_str());
-	const std::string section = "ZeroFun/";
-	const std::string subsection{method_name + "/"};
-	
-	const SolverTraits::Real		tol = datafile((section + "tol").data(), 1.e-5);
-	const SolverTraits::Uint		maxIt = datafile((section + "maxIt").data(), 200);
-	const SolverTraits::Real		tola = datafile((section + subsection + "tola").data(), 1.e-10);
-	const SolverTraits::InputType	x = datafile((section + subsection + "x").data(), 0.0);
-	const SolverTraits::InputType	a = datafile((section + subsection + "a").data(), 0.0);
-	const SolverTraits::InputType	b = datafile((section + subsection + "b").data(), 1.0);
-	const SolverTraits::Interval	interval = std::make_pair(a, b);
-	const SolverTraits::InputType	h = datafile((section + subsection + "h").data(), 1.e-2); 
-	const SolverTraits::InputType	sol_ex = datafile((section + "sol_ex").data(),
-													   std::numeric_limits<SolverTraits::InputType>::quiet_NaN()); 
-	const SolverTraits::Uint		maxIt_interval = datafile((section + subsection + "maxIt_interval").data(), 200);
-	const SolverTraits::InputType	h_interval = datafile((section + subsection + "h_interval").data(), 0.1);
-	
-	// Initialize the solver factory and a unique_ptr to base class to apply polymorphism
-	SolverFactory solver;
-	std::unique_ptr<SolverBase> my_ptr = nullptr;
-		
-	// Solve the problem
-	if(method_name == "Bisection")
-		my_ptr = solver.make_solver<Bisection>(myfun, tol, maxIt, interval, maxIt_interval, h_interval);
-
-	else if(method_name == "RegulaFalsi")
-		my_ptr = solver.make_solver<RegulaFalsi>(myfun, tol, maxIt, tola, interval, maxIt_interval, h_interval);
-
-	else if(method_name == "Brent")
-		my_ptr = solver.make_solver<Brent>(myfun, tol, maxIt, interval, maxIt_interval, h_interval);
-
-	else if(method_name == "Secant")
-		my_ptr = solver.make_solver<Secant>(myfun, tol, maxIt, tola, interval);
-
-	else if(method_name == "Newton")
-		my_ptr = solver.make_solver<Newton>(myfun, tol, maxIt, tola, x, mydfun);
+	LevelSetSolver level_set(myfun, config);
+	std::vector<SolverTraits::SolverOutput> res;
+	
+	if(config.refine == "Bisection")
+		res = level_set.solve<Bisection>(config.targets);
+	
+	else
+		res = level_set.solve<Brent>(config.targets);
+	
+	std::cout << "Finding the level sets with " << config.refine << " refinement" << std::endl;
+	for(unsigned int i = 0u; i < config.targets.size(); ++i)
+	{
+		if(res[i].second)
+			std::cout << "f(" << res[i].first << ") = " << config.targets[i] << std::endl;
+		else
+			std::cout << "Level " << config.targets[i] << " not found!" << std::endl;
+	}
+	
+	return 0;
+}
 
-	else if(method_name == "QuasiNewton")
-		my_ptr = solver.make_solver<QuasiNewton>(myfun, tol, maxIt, tola, x, h);
 
-	else
+// Compute all the roots of the polynomial in config
+int solve_polynomial(const MethodConfig & config)
+{
+	PolySolverFactory solver;
+	std::unique_ptr<PolySolverBase> my_ptr = solver.make_solver(config);
+	
+	if(my_ptr == nullptr)
 	{
 		std::cout << "ERROR: invalid method" << std::endl;
 		return 1;
 	}
+	
+	std::cout << "Finding the roots of the polynomial with " << config.label << " method" << std::endl;
+	PolySolverBase::PolySolverOutput res = my_ptr -> solve();
+	
+	if(res.second)
+		for(const PolySolverTraits::Complex & root : res.first)
+			std::cout << "Root " << root.real() << (root.imag() < 0. ? " - " : " + ") << std::abs(root.imag()) 
+					  << "i" << std::endl;
+	else
+		std::cout << "Roots not found! Try to change the parameters" << std::endl;
+	
+	return 0;
+}
+
+
+// Compute the zero of myfun with the method in config, looking first in the result cache (if any)
+int solve_zero(MethodConfig config, const SolverTraits::InputType & sol_ex, ResultCache * cache)
+{
+	ResultCache::Key				key{0u};
+	ResultCache::Key				warm_key{0u};
+	SolverBase::SolverOutput		res;
+	bool							cached{false};
+	bool							warm{false};
+	
+	// Look for the problem in the result cache before constructing any solver
+	if(cache != nullptr)
+	{
+		std::ostringstream signature;
+		signature << std::hexfloat << function_id << "/" << config.name << "/" << config.tol << "/" << config.maxIt 
+				  << "/" << config.tola << "/" << config.x << "/" << config.interval.first << "/" 
+				  << config.interval.second << "/" << config.h << "/" << config.maxIt_interval << "/" 
+				  << config.h_interval;
+		key = ResultCache::hash(signature.str());
+		
+		// Only the methods with an initial point can start from a zero found with other parameters or
+		// methods, the bracket of the interval methods is never changed
+		warm_key = (config.name == "Newton" || config.name == "QuasiNewton" || config.name == "Secant") ? 
+				   ResultCache::hash(function_id) : key;
+		
+		if(cache -> lookup(key, warm_key, res, warm))
+		{
+			if(!warm)
+				cached = true;
+			
+			else if(res.second)
+			{
+				std::cout << "Warm start from the cached zero " << res.first << std::endl;
+				if(config.name == "Secant")
+					config.interval.first = res.first;
+				else
+					config.x = res.first;
+			}
+		}
+	}
+	
+	if(cached)
+		std::cout << "Zero found with " << config.label << " method in the cache " << cache -> get_filename() << std::endl;
+	
+	else
+	{
+		// Initialize the solver factory and a unique_ptr to base class to apply polymorphism
+		SolverFactory solver;
+		std::unique_ptr<SolverBase> my_ptr = solver.make_solver(config, myfun, mydfun);
+		
+		if(my_ptr == nullptr)
+		{
+			std::cout << "ERROR: invalid method" << std::endl;
+			return 1;
+		}
 
-	std::cout << "Finding the zero with " << method_name << " method" << std::endl;
-	SolverBase::SolverOutput res = my_ptr -> solve();
+		// Solve the problem
+		std::cout << "Finding the zero with " << config.label << " method" << std::endl;
+		res = my_ptr -> solve();
 		
+		// A converged warm started result is a zero within the tolerances of the problem as given, so
+		// the next identical problem finds it under its own key; a warm start that did not converge says
+		// nothing about the problem as given and is not stored under its key
+		if(cache != nullptr)
+		{
+			if(!warm || res.second)
+				cache -> store(key, res);
+			if(res.second)
+				cache -> store(ResultCache::hash(function_id), res);
+		}
+	}
+	
 	if(res.second)
 	{
 		std::cout << "The zero is " << res.first << std::endl;
@@ -95,3 +168,99 @@ int main(int argc, char **argv)
 	
 	return 0;
 }
+
+
+// Compute the zero of a function with the methods in input
+int main(int argc, char **argv)
+{
+	// Read in input from command line the datafile name, the configurations to use (comma separated
+	// methods or <method>.<suffix> sections of the datafile) and
+	// the profiling options
+	std::string					filename{"data"};
+	std::vector<std::string>	method_names;
+	bool						profile{false};
+	std::string					profile_file;
+	
+	for(int i = 1; i < argc; ++i)
+	{
+		const std::string arg{argv[i]};
+		
+		if((arg == "-f" || arg == "--file") && i + 1 < argc)
+			filename = argv[++i];
+		
+		else if(arg == "--profile")
+			profile = true;
+		
+		else if(arg == "--profile-out" && i + 1 < argc)
+		{
+			profile = true;
+			profile_file = argv[++i];
+		}
+		
+		else if(arg.compare(0, 7, "method=") == 0)
+		{
+			std::istringstream methods(arg.substr(7));
+			for(std::string method; std::getline(methods, method, ',');)
+				if(!method.empty())
+					method_names.push_back(method);
+		}
+	}
+	
+	if(method_names.empty())
+		method_names.push_back("Bisection");
+	
+	if(profile)
+	{
+#ifdef ZEROFUN_PROFILE
+		Profiler::instance().set_enabled(true);
+#else
+		std::cout << "ERROR: profiling not available, build main_profile with make profile" << std::endl;
+		profile = false;
+#endif
+	}
+
+	// Read the parameters of all the methods from datafile (or from its binary copy)
+	const ZeroFunConfig zerofun(filename);
+	
+	std::unique_ptr<ResultCache> cache = nullptr;
+	if(!zerofun.get_cache_file().empty())
+		cache = std::make_unique<ResultCache>(zerofun.get_cache_file(), zerofun.get_cache_size());
+	
+	int status{0};
+	
+	for(const std::string & method_name : method_names)
+	{
+		if(!zerofun.validate(method_name))
+		{
+			status = 1;
+			continue;
+		}
+		
+		const MethodConfig & config = *zerofun.get(method_name);
+		
+		// The result cache stores single zeros: LevelSet and the polynomial methods are always solved
+		if(config.name == "LevelSet")
+			status = std::max(status, solve_level_set(config));
+		else if(config.name == "AberthEhrlich" || config.name == "DurandKerner")
+			status = std::max(status, solve_polynomial(config));
+		else
+			status = std::max(status, solve_zero(config, zerofun.get_sol_ex(), cache.get()));
+	}
+	
+	if(cache != nullptr)
+		std::cout << "Cache hits " << cache -> get_hits() << " (warm starts " << cache -> get_warm_hits() 
+				  << "), misses " << cache -> get_misses() << std::endl;
+	
+	if(profile)
+	{
+		Profiler::instance().report(std::cout);
+		
+		if(!profile_file.empty())
+		{
+			std::ofstream out(profile_file);
+			Profiler::instance().report(out);
+		}
+	}
+	
+	return status;
+}